@@ -10,6 +10,8 @@ It's intended to serve as a basic shop calculator for school events or similar t
 #include <WiFi.h>
 #include <WebServer.h>
 #include <EEPROM.h>
+#include <LittleFS.h>
+#include <functional>
 
 const char* ssid = "Kasse";         // SSID of th WIFI
 const char* password = "BitteGeld"; // Password for WIFI
@@ -19,34 +21,84 @@ const char* password = "BitteGeld"; // Password for WIFI
 WebServer server(80);        // product page
 WebServer configServer(8080); // config page
 
-#define MAX_PRODUCTS 50 // max number of products in the shop
+#define MAX_PRODUCTS 250 // max number of products in the catalogue (limited by the sales counters in EEPROM)
+#define MAX_CATEGORIES 16 // max number of categories
+#define MAX_NAME_LENGTH 64 // max length of product and category names in bytes (UTF-8)
+#define PAGE_SIZE 20 // number of products shown per page of a category
+#define CART_MAX_ITEMS 20 // max number of different products in the cart
 #define EEPROM_SIZE 4096 // size of EEPROM in bytes (4kB)
 #define LED_PIN 2  // GPIO der Onboard-LED (meist GPIO 2)
 #define SALES_EEPROM_ADDR 600
-#define EEPROM_PRODUCTS_START 0
+#define EEPROM_PRODUCTS_START 0 // products of old firmware versions, only read once to move them to the file system
 #define EEPROM_SALES_START 1000
+#define LEGACY_MAX_PRODUCTS 50 // max number of products of old firmware versions
+#define PRODUCTS_FILE "/products.txt" // one product per line: category;price;deposit;name
+#define PRODUCTS_TMP_FILE "/products.tmp" // used while rewriting the products file
+#define CATEGORIES_FILE "/categories.txt" // one category name per line, line number is the category id
+#define CATEGORIES_TMP_FILE "/categories.tmp" // used while rewriting the categories file
+#define ORDER_QUEUE_SIZE 16 // number of orders kept in RAM for the kitchen display (oldest gets overwritten)
+#define ORDER_MAX_ITEMS CART_MAX_ITEMS // max number of different products per order, a whole cart always fits
+#define ORDER_NUMBER_MAX 99 // order numbers run from 1 to 99 and start over again
 
 unsigned long previousMillis = 0;
 const long interval = 900; // blinking interval
 bool ledOn = false; // state of status led
 
+// Products are stored in the file system and only loaded page by page, so RAM usage doesn't grow with the catalogue.
+// The product id is the line number in the products file.
 struct Product {
-  char name[30]; // product name max 30 chars due to EEPROM size limitations
+  String name; // product name (UTF-8, max MAX_NAME_LENGTH bytes)
   float price; // two decimal places
   bool hasDeposit; // true if product has deposit
+  uint8_t category; // index into categories[]
+};
+
+int productCount = 0; // number of products in the products file
+bool fileSystemMounted = false; // false if LittleFS couldn't be mounted, shop then runs without products
+
+String categories[MAX_CATEGORIES]; // category table
+int categoryCount = 0;
+int categoryProductCount[MAX_CATEGORIES]; // number of products per category for paging
+
+// product in the cart, keeps a copy of the product data so the cart doesn't need the file system
+struct CartItem {
+  uint16_t productId; // line in products file
   int count; // number of products in cart
-  int sold; // number of products sold (for sales overview)
+  String name;
+  float price;
+  bool hasDeposit;
+};
+
+CartItem cart[CART_MAX_ITEMS];
+int cartSize = 0; // number of used entries in cart[]
+
+// one line of a submitted order, keeps a copy of the name so the queue doesn't need the file system
+// and deleting or editing products doesn't change open orders
+struct OrderItem {
+  char name[MAX_NAME_LENGTH + 1];
+  int quantity;  // number of this product in the order
+};
+
+// submitted order waiting in the kitchen queue
+struct Order {
+  uint8_t number; // short order number shown to customer and kitchen (0 = slot unused)
+  bool done; // true if kitchen marked the order as done
+  uint8_t itemCount; // number of used entries in items[]
+  uint32_t sequence; // increases with every order, used to show orders oldest first
+  OrderItem items[ORDER_MAX_ITEMS];
 };
 
-Product products[MAX_PRODUCTS]; // Array for products
-int productCount = 0;
+Order orderQueue[ORDER_QUEUE_SIZE]; // fixed size so RAM usage does not grow, new orders only replace unused or done orders
+uint32_t orderSequence = 0; // sequence of the last order
+uint32_t orderQueueVersion = 1; // changes whenever the queue changes, displays only reload the queue if it differs
+uint8_t lastOrderNumber = 0; // last order number that was handed out
 
-int totalSold[MAX_PRODUCTS]; // cumulative number sold per product
 
+// if file system is empty, default categories and products are loaded
+const char* defaultCategories[] = {"Getränke", "Essen"};
 
-// if EEPROM is empty, default products are loaded
 Product defaultProducts[] = {
-  {"Brezel", 2.50, false, 0},
+  {"Brezel", 2.50, false, 1},
   {"Fanta", 2.50, true, 0},
   {"Cola", 2.50, true, 0},
   {"Spezi", 3.00, true, 0},
@@ -57,107 +109,247 @@ Product defaultProducts[] = {
   {"Sekt", 3.00, true, 0}
 };
 
+const int defaultCategoryCount = sizeof(defaultCategories) / sizeof(defaultCategories[0]);
 const int defaultProductCount = sizeof(defaultProducts) / sizeof(defaultProducts[0]);
 
+// product layout of old firmware versions that stored the products in EEPROM
+struct LegacyProduct {
+  char name[30];
+  float price;
+  bool hasDeposit;
+  int count;
+  int sold;
+};
+
+
+// SALES (stored in EEPROM, one int per product id)
+int getSold(int id) {
+  int sold = EEPROM.readInt(EEPROM_SALES_START + id * sizeof(int));
+  return sold == -1 ? 0 : sold; // empty EEPROM returns -1
+}
+
+void setSold(int id, int sold) {
+  EEPROM.writeInt(EEPROM_SALES_START + id * sizeof(int), sold);
+}
+
 void saveSalesToEEPROM() {
-  for (int i = 0; i < productCount; i++) {
-    EEPROM.writeInt(EEPROM_SALES_START + i * sizeof(int), totalSold[i]);
-  }
   EEPROM.commit();
 }
 
-void loadSalesFromEEPROM() {
-  for (int i = 0; i < productCount; i++) {
-    // Ensure that the sales count starts at 0 if there's no valid data
-    totalSold[i] = EEPROM.readInt(EEPROM_SALES_START + i * sizeof(int));
-    if (totalSold[i] == -1) {
-      totalSold[i] = 0;  // Reset to 0 if EEPROM returns an invalid value
-    }
+
+// PRODUCT FILE management
+// remove line breaks (would break the file format) and cut name to MAX_NAME_LENGTH bytes without splitting a UTF-8 character
+String cleanName(String name) {
+  name.replace("\r", "");
+  name.replace("\n", " ");
+  name.trim();
+  if (name.length() > MAX_NAME_LENGTH) {
+    int end = MAX_NAME_LENGTH;
+    while (end > 0 && ((uint8_t)name[end] & 0xC0) == 0x80) end--; // continuation byte, go back to start of character
+    name = name.substring(0, end);
   }
+  return name;
 }
 
-void printEEPROMData() {
-  Serial.println("EEPROM Data:");
-  for (int i = 0; i < productCount; i++) {
-    Product p;
-    EEPROM.get(i * sizeof(Product), p); // Read product data from EEPROM
-    Serial.print("Product ");
-    Serial.print(i);
-    Serial.print(": Name: ");
-    Serial.print(p.name);
-    Serial.print(", Price: ");
-    Serial.print(p.price);
-    Serial.print(", Quantity: ");
-    Serial.println(p.count);
+// read next product from the products file, returns false at end of file
+bool readProduct(File &file, Product &p) {
+  if (!file || !file.available()) return false;
+  String line = file.readStringUntil('\n');
+  int a = line.indexOf(';');
+  int b = line.indexOf(';', a + 1);
+  int c = line.indexOf(';', b + 1);
+  p.category = line.substring(0, a).toInt();
+  if (p.category >= categoryCount) p.category = 0; // category was deleted from categories file
+  p.price = line.substring(a + 1, b).toFloat();
+  p.hasDeposit = line.substring(b + 1, c) == "1";
+  p.name = c >= 0 ? line.substring(c + 1) : "";
+  return true;
+}
+
+// append product as one line to the products file (name last so it may contain ';'), returns false if the write failed
+bool writeProduct(File &file, const Product &p) {
+  String line = String(p.category) + ";" + String(p.price, 2) + ";" + (p.hasDeposit ? "1" : "0") + ";" + p.name + "\n";
+  return file.print(line) == line.length();
+}
+
+// replace file by its completely written temporary copy, rename replaces the original in one step
+// so a power loss or full file system never leaves us without the file
+bool replaceFile(File &tmp, bool written, const char* tmpPath, const char* path) {
+  tmp.close();
+  if (!written || !LittleFS.rename(tmpPath, path)) {
+    LittleFS.remove(tmpPath); // original stays in place
+    Serial.println("Could not write " + String(path));
+    return false;
   }
+  return true;
 }
 
-// EEPROM management
-// save to EEPROM
-void saveProductsToEEPROM() {
-  // Save the product count first (at the beginning of EEPROM)
-  EEPROM.put(0, productCount);
+// read a single product by its id, returns false if there is no such product
+bool readProductById(int id, Product &p) {
+  if (id < 0 || id >= productCount) return false;
+  File file = LittleFS.open(PRODUCTS_FILE, "r");
+  bool found = false;
+  for (int i = 0; i <= id && readProduct(file, p); i++) {
+    found = i == id;
+  }
+  file.close();
+  return found;
+}
 
-  // Write the products to EEPROM
-  for (int i = 0; i < productCount; i++) {
-    EEPROM.put((i * sizeof(Product)) + sizeof(int), products[i]);
+// write category table to the file system, returns false if it could not be written
+bool saveCategories() {
+  File file = LittleFS.open(CATEGORIES_TMP_FILE, "w");
+  bool written = (bool)file;
+  for (int i = 0; written && i < categoryCount; i++) {
+    String line = categories[i] + "\n";
+    written = file.print(line) == line.length();
   }
-  EEPROM.commit(); // Commit changes to EEPROM
-  printEEPROMData(); // Print EEPROM data for debugging
+  return replaceFile(file, written, CATEGORIES_TMP_FILE, CATEGORIES_FILE);
 }
 
-void loadProductsFromEEPROM() {
-  EEPROM.begin(EEPROM_SIZE);  // Initialize EEPROM
+// rewrite products file product by product, edit() may change the product and returns false to delete it
+// returns false if the file could not be written, the old products file stays unchanged then
+bool rewriteProducts(std::function<bool(int, Product&)> edit) {
+  File in = LittleFS.open(PRODUCTS_FILE, "r");
+  if (!in) return false;
+  File out = LittleFS.open(PRODUCTS_TMP_FILE, "w");
+  bool written = (bool)out;
+  Product p;
+  for (int id = 0; written && readProduct(in, p); id++) {
+    if (edit(id, p)) written = writeProduct(out, p);
+  }
+  in.close();
+  return replaceFile(out, written, PRODUCTS_TMP_FILE, PRODUCTS_FILE);
+}
 
-  // Check if EEPROM is empty by reading the first product name
-  char testName[30] = "";
-  EEPROM.get(sizeof(int), testName);  // Read first product name (skip product count)
-  Serial.print("testName: ");
-  Serial.println(testName);  // Debug output to check if EEPROM is empty
+// write default categories and products to the file system
+bool saveDefaultProducts() {
+  categoryCount = 0;
+  for (int i = 0; i < defaultCategoryCount; i++) {
+    categories[categoryCount++] = defaultCategories[i];
+  }
+  if (!saveCategories()) return false;
 
-  if (String(testName) == "") {  // EEPROM is empty
-    Serial.println("EEPROM is empty, loading default products.");
-    // Load default products into EEPROM if it's empty
-    for (int i = 0; i < defaultProductCount; i++) {
-      EEPROM.put((i * sizeof(Product)) + sizeof(int), defaultProducts[i]);  // Skip product count location
-    }
-    productCount = defaultProductCount; // Set product count to default product count
-    EEPROM.put(0, productCount); // Store product count at the beginning of EEPROM
-    EEPROM.commit(); // Save to EEPROM
-  } else {
-    EEPROM.get(0, productCount);  // Read product count from the beginning of EEPROM
-    Serial.println("EEPROM is not empty, loading saved products.");
+  File file = LittleFS.open(PRODUCTS_TMP_FILE, "w");
+  bool written = (bool)file;
+  for (int i = 0; written && i < defaultProductCount; i++) {
+    written = writeProduct(file, defaultProducts[i]);
+  }
+  return replaceFile(file, written, PRODUCTS_TMP_FILE, PRODUCTS_FILE);
+}
 
-    // Ensure productCount is within bounds to avoid memory overflow
-    if (productCount > MAX_PRODUCTS) {
-      Serial.println("Warning: productCount exceeds max limit, resetting to max.");
-      productCount = MAX_PRODUCTS; // Reset to max products if it exceeds
-    }
+// move products of old firmware versions from EEPROM to the file system, returns false if there are none
+bool importProductsFromEEPROM() {
+  int legacyCount = 0;
+  EEPROM.get(EEPROM_PRODUCTS_START, legacyCount);
+  if (legacyCount <= 0 || legacyCount > LEGACY_MAX_PRODUCTS) return false; // empty EEPROM reads -1
+
+  Serial.println("Moving " + String(legacyCount) + " products from EEPROM to file system.");
+  categoryCount = 0;
+  categories[categoryCount++] = "Allgemein";
+  if (!saveCategories()) return false;
+
+  File file = LittleFS.open(PRODUCTS_TMP_FILE, "w");
+  bool written = (bool)file;
+  for (int i = 0; written && i < legacyCount; i++) {
+    LegacyProduct legacy;
+    EEPROM.get(EEPROM_PRODUCTS_START + (i * sizeof(LegacyProduct)) + sizeof(int), legacy); // skip product count location
+    legacy.name[sizeof(legacy.name) - 1] = '\0';
+    Product p = {cleanName(String(legacy.name)), legacy.price, legacy.hasDeposit, 0};
+    written = writeProduct(file, p);
+  }
+  if (!replaceFile(file, written, PRODUCTS_TMP_FILE, PRODUCTS_FILE)) return false;
 
-    // Load saved products from EEPROM
-    for (int i = 0; i < productCount; i++) {
-      EEPROM.get((i * sizeof(Product)) + sizeof(int), products[i]);  // Skip product count location
+  EEPROM.put(EEPROM_PRODUCTS_START, 0); // don't import again
+  EEPROM.commit();
+  return true;
+}
+
+// load category table and count products, catalogue itself stays in the file system
+// loadDefaults: write default products if there are none (only tried once so a broken file system can't loop)
+void loadCatalogue(bool loadDefaults = true) {
+  if (!fileSystemMounted) return;
+
+  // power loss right after writing the temporary file, use it
+  if (!LittleFS.exists(PRODUCTS_FILE) && LittleFS.exists(PRODUCTS_TMP_FILE)) {
+    Serial.println("Restoring products from " PRODUCTS_TMP_FILE);
+    LittleFS.rename(PRODUCTS_TMP_FILE, PRODUCTS_FILE);
+  }
+  if (!LittleFS.exists(CATEGORIES_FILE) && LittleFS.exists(CATEGORIES_TMP_FILE)) {
+    LittleFS.rename(CATEGORIES_TMP_FILE, CATEGORIES_FILE);
+  }
+
+  if (!LittleFS.exists(PRODUCTS_FILE)) {
+    if (!importProductsFromEEPROM()) {
+      Serial.println("File system is empty, loading default products.");
+      saveDefaultProducts();
     }
   }
+
+  categoryCount = 0;
+  File file = LittleFS.exists(CATEGORIES_FILE) ? LittleFS.open(CATEGORIES_FILE, "r") : File();
+  while (file && file.available() && categoryCount < MAX_CATEGORIES) {
+    // every line is a category, also empty ones, otherwise the ids of the following categories would change
+    String name = cleanName(file.readStringUntil('\n'));
+    if (name.length() == 0) name = "Kategorie " + String(categoryCount + 1);
+    categories[categoryCount++] = name;
+  }
+  file.close();
+  if (categoryCount == 0) { // categories file missing, products are shown in one category
+    categories[categoryCount++] = "Allgemein";
+    saveCategories();
+  }
+
+  productCount = 0;
+  for (int i = 0; i < MAX_CATEGORIES; i++) categoryProductCount[i] = 0;
+  file = LittleFS.open(PRODUCTS_FILE, "r");
+  Product p;
+  while (readProduct(file, p)) {
+    productCount++;
+    categoryProductCount[p.category]++;
+  }
+  file.close();
+
+  // all products deleted, start over with default products
+  if (productCount == 0 && loadDefaults) {
+    Serial.println("No products found, loading default products.");
+    saveDefaultProducts();
+    loadCatalogue(false);
+    return;
+  }
+  if (productCount == 0) Serial.println("Default products could not be saved.");
+
+  Serial.println("productCount: " + String(productCount) + ", categoryCount: " + String(categoryCount));
 }
 
-void handleSellProduct(String productName) {
-  for (int i = 0; i < productCount; i++) {
-    if (String(products[i].name) == productName) {
-      products[i].count++; // Increase the sold count
-      saveProductsToEEPROM(); // Save the updated product list
-      break;
-    }
+// CART
+// find product in cart, returns -1 if it's not in the cart
+int findCartItem(int id) {
+  for (int i = 0; i < cartSize; i++) {
+    if (cart[i].productId == id) return i;
+  }
+  return -1;
+}
+
+// number of a product in the cart
+int cartCount(int id) {
+  int i = findCartItem(id);
+  return i < 0 ? 0 : cart[i].count;
+}
+
+void removeCartItem(int index) {
+  for (int i = index; i < cartSize - 1; i++) {
+    cart[i] = cart[i + 1];
   }
-  // You might want to show some feedback here, e.g., redirect to a confirmation page
+  cartSize--;
 }
 
 // cacluate total price of all products in cart
 float calculateTotal() {
   float total = 0;
-  for (int i = 0; i < productCount; i++) {
-    total += products[i].count * products[i].price;
-    if (products[i].hasDeposit) total += products[i].count * 1.0;
+  for (int i = 0; i < cartSize; i++) {
+    total += cart[i].count * cart[i].price;
+    if (cart[i].hasDeposit) total += cart[i].count * 1.0;
   }
   return total;
 }
@@ -165,79 +357,133 @@ float calculateTotal() {
 // calculate total deposit of all products in cart (is gonna be shown as already included in total price)
 float calculateDeposit() {
   float deposit = 0;
-  for (int i = 0; i < productCount; i++) {
-    if (products[i].hasDeposit) deposit += products[i].count * 1.0;
+  for (int i = 0; i < cartSize; i++) {
+    if (cart[i].hasDeposit) deposit += cart[i].count * 1.0;
   }
   return deposit;
 }
 
+// ORDER QUEUE
+// slot for a new order: an unused one, else the oldest done order, -1 if all orders are still open
+int findFreeOrderSlot() {
+  int slot = -1;
+  for (int i = 0; i < ORDER_QUEUE_SIZE; i++) {
+    if (orderQueue[i].number == 0) return i;
+    if (orderQueue[i].done && (slot < 0 || orderQueue[i].sequence < orderQueue[slot].sequence)) slot = i;
+  }
+  return slot;
+}
+
+// true if an open order already uses this number
+bool isOrderNumberOpen(uint8_t number) {
+  for (int i = 0; i < ORDER_QUEUE_SIZE; i++) {
+    if (orderQueue[i].number == number && !orderQueue[i].done) return true;
+  }
+  return false;
+}
+
+// put current cart into the order queue and return its order number (0 if cart is empty)
+// call only if findFreeOrderSlot() found a slot
+uint8_t enqueueOrder() {
+  Order order = {};
+  for (int i = 0; i < cartSize; i++) { // cartSize <= ORDER_MAX_ITEMS, whole cart fits into the order
+    cart[i].name.toCharArray(order.items[i].name, sizeof(order.items[i].name));
+    order.items[i].quantity = cart[i].count;
+    order.itemCount++;
+  }
+  if (order.itemCount == 0) return 0; // nothing to cook, slot stays free
+
+  do {
+    lastOrderNumber = lastOrderNumber % ORDER_NUMBER_MAX + 1;
+  } while (isOrderNumberOpen(lastOrderNumber)); // skip numbers of orders still waiting in the kitchen
+  order.number = lastOrderNumber;
+  order.done = false;
+  order.sequence = ++orderSequence;
+  orderQueue[findFreeOrderSlot()] = order;
+  orderQueueVersion++;
+  return order.number;
+}
+
+// find order in queue by its number, returns nullptr if it's not in the queue (anymore)
+// numbers repeat after ORDER_NUMBER_MAX orders, so the newest order with this number is returned
+Order* findOrder(int number) {
+  Order* found = nullptr;
+  if (number <= 0) return found;
+  for (int i = 0; i < ORDER_QUEUE_SIZE; i++) {
+    if (orderQueue[i].number == number && (!found || orderQueue[i].sequence > found->sequence)) found = &orderQueue[i];
+  }
+  return found;
+}
+
+// HTML list of items of an order
+String generateOrderItems(const Order &order) {
+  String content = "<ul>";
+  for (int i = 0; i < order.itemCount; i++) {
+    content += "<li>" + String(order.items[i].quantity) + "x " + String(order.items[i].name) + "</li>";
+  }
+  content += "</ul>";
+  return content;
+}
+
 
 void handleSalesOverview() {
-  loadSalesFromEEPROM(); // load sales from EEPROM
-  
-  // Start the HTML content
-  String html = "<h1>Verkäufe</h1>";
-  
-  // Create a table for the sales
-  html += "<table border='1'><tr><th>Produkt</th><th>Anzahl</th></tr>";
-  
+  // Send the page in chunks, so the whole catalogue doesn't have to fit into one String
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/html; charset=UTF-8", "");
+
+  // Start the HTML content and create a table for the sales
+  server.sendContent("<h1>Verkäufe</h1>");
+  server.sendContent("<table border='1'><tr><th>Kategorie</th><th>Produkt</th><th>Anzahl</th></tr>");
+
   // Loop through the products and add them to the table
-  for (int i = 0; i < productCount; i++) {
-    html += "<tr><td>" + String(products[i].name) + "</td><td>" + String(totalSold[i]) + "</td></tr>";
+  File file = LittleFS.open(PRODUCTS_FILE, "r");
+  Product p;
+  for (int id = 0; readProduct(file, p); id++) {
+    server.sendContent("<tr><td>" + categories[p.category] + "</td><td>" + p.name + "</td><td>" + String(getSold(id)) + "</td></tr>");
   }
+  file.close();
   Serial.print("productCount: ");
   Serial.println(productCount);
-  for (int i = 0; i < productCount; i++) {
-    Serial.print("Product ");
-    Serial.print(i);
-    Serial.print(": ");
-    Serial.print(products[i].name);
-    Serial.print(" - verkauft: ");
-    Serial.println(totalSold[i]);
-  }
-  
+
   // Close the table tag
-  html += "</table>";
+  server.sendContent("</table>");
 
   // Add the export CSV button
-  html += "<form action='/exportSales' method='post'><button type='submit'>Exportiere Verkäufe als CSV</button></form>";
+  server.sendContent("<form action='/exportSales' method='post'><button type='submit'>Exportiere Verkäufe als CSV</button></form>");
 
   // Add the reset sales button
-  html += "<form action='/resetSales' method='post'><button type='submit'>Verkäufe zurücksetzen</button></form>";
-
-  // Set the Content-Type header to UTF-8
-  server.sendHeader("Content-Type", "text/html; charset=UTF-8");
-  
-  // Send the HTML response
-  server.send(200, "text/html", html);
+  server.sendContent("<form action='/resetSales' method='post'><button type='submit'>Verkäufe zurücksetzen</button></form>");
+  server.sendContent(""); // end of chunked response
 }
 
 
+// quote CSV field, names may contain commas and quotes
+String csvField(String value) {
+  value.replace("\"", "\"\"");
+  return "\"" + value + "\"";
+}
+
 // Endpoint to handle CSV export
 void handleExportSales() {
-  String csvData = "Produkt,Anzahl\n";
-  for (int i = 0; i < productCount; i++) {
-    csvData += String(products[i].name) + "," + String(totalSold[i]) + "\n";
-  }
-  
   server.sendHeader("Content-Disposition", "attachment; filename=sales.csv");
-  server.sendHeader("Content-Type", "text/csv");
-  server.send(200, "text/csv", csvData);
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/csv", "Kategorie,Produkt,Anzahl\n");
+
+  File file = LittleFS.open(PRODUCTS_FILE, "r");
+  Product p;
+  for (int id = 0; readProduct(file, p); id++) {
+    server.sendContent(csvField(categories[p.category]) + "," + csvField(p.name) + "," + String(getSold(id)) + "\n");
+  }
+  file.close();
+  server.sendContent(""); // end of chunked response
 }
 
 // Endpoint to handle sales reset
 void handleResetSales() {
-  // Reset the sales data, you can clear the totalSold array or reset EEPROM data here
-  for (int i = 0; i < productCount; i++) {
-    totalSold[i] = 0; // Reset the total sales for each product
-  }
-
-  // Keine Änderung der Produktdaten im EEPROM, nur Verkaufsdaten zurücksetzen
-  EEPROM.begin(EEPROM_SIZE); // Ensure EEPROM is initialized
+  // Keine Änderung der Produktdaten, nur Verkaufsdaten zurücksetzen
   for (int i = 0; i < productCount; i++) {
-    EEPROM.writeInt(EEPROM_SALES_START + i * sizeof(int), 0); // Reset sales data, not product data
+    setSold(i, 0); // Reset the total sales for each product
   }
-  EEPROM.commit(); // Save changes to EEPROM
   saveSalesToEEPROM(); // Save the reset sales data to EEPROM
 
   // Redirect to the sales overview page after resetting
@@ -249,42 +495,18 @@ void handleResetSales() {
 
 
 
-// HTML for product page
-String generateProductList() {
-  String content = "";
-
-  // repeated for the number of products in the shop
-  for (int i = 0; i < productCount; i++) {
-    content += "<div class='product'>";
-    content += "<p><strong>" + String(products[i].name) + "</strong> (" + String(products[i].price, 2) + " €";
-    if (products[i].hasDeposit) content += " + 1 € Pfand";
-    content += ")</p>";
-    content += "<div class='row'><div class='left'>";
-    content += "<span>Anzahl: " + String(products[i].count) + "</span>";
-
-    // add product buttons
-    content += "<button onclick='sendAction(\"add\", " + String(i) + ", 1)' style='background-color: green; color: white;'>+1</button>"; // +1 Button
-    content += "<button onclick='sendAction(\"add\", " + String(i) + ", 2)' style='background-color: green; color: white;'>+2</button>"; // +2 Button
-    content += "<button onclick='sendAction(\"add\", " + String(i) + ", 3)' style='background-color: green; color: white;'>+3</button>"; // +3 Button
-
-    content += "</div>";
-
-    // -1 button on the right side of the row
-    content += "<button onclick='sendAction(\"remove\", " + String(i) + ")' style='background-color: red; color: white;'>-1</button>";
-
-    content += "</div>"; // line end
-    content += "</div>"; // product block end
+// category dropdown for config page
+String generateCategorySelect(String name, int selected) {
+  String html = "<select class='input-field' name='" + name + "'>";
+  for (int i = 0; i < categoryCount; i++) {
+    html += "<option value='" + String(i) + "'" + (i == selected ? " selected" : "") + ">" + categories[i] + "</option>";
   }
-
-  content += "<h3>Gesamtpreis: " + String(calculateTotal(), 2) + " €<br>";
-  content += "<small>(inkl. " + String(calculateDeposit(), 2) + " € Pfand)</small></h3>";
-  content += "<button onclick='sendAction(\"clear\", -1)'>Warenkorb löschen</button>";
-
-  return content;
+  html += "</select>";
+  return html;
 }
 
-// configuration page HTML
-String generateConfigPage() {
+// configuration page HTML, only shows one page of one category
+String generateConfigPage(int cat, int page) {
   // HTML template for the configuration page
   String html = R"rawliteral(
     <!DOCTYPE html>
@@ -339,35 +561,88 @@ String generateConfigPage() {
         hr {
           margin-top: 20px;
         }
+        .tabs a {
+          display: inline-block;
+          margin: 2px;
+          padding: 8px 15px;
+          border-radius: 10px;
+          background-color: #007BFF;
+          color: white;
+          text-decoration: none;
+        }
+        .tabs a.active {
+          background-color: #0056b3;
+          font-weight: bold;
+        }
+        select {
+          padding: 8px;
+          margin-top: 4px;
+          border-radius: 5px;
+          border: 1px solid #ccc;
+        }
       </style>
     </head>
     <body>
     )rawliteral";    
   html += "<style>.input-field { width: 90%; box-sizing: border-box; }</style>";  // CSS fix for input fields to be 90% of the page width
-  html += "<h1>Produktkonfiguration</h1><form method='POST' action='/saveConfig'>";
-  // repeated for the number of products in the shop, adding the product name, price and deposit checkbox for each product
-  for (int i = 0; i < productCount; i++) {
+  html += "<h1>Produktkonfiguration</h1>";
+
+  // category tabs
+  html += "<div class='tabs'>";
+  for (int i = 0; i < categoryCount; i++) {
+    html += "<a href='/?cat=" + String(i) + "'" + (i == cat ? " class='active'" : "") + ">" + categories[i] + " (" + String(categoryProductCount[i]) + ")</a>";
+  }
+  html += "</div>";
+
+  html += "<form method='POST' action='/saveConfig'>";
+  html += "<input type='hidden' name='cat' value='" + String(cat) + "'><input type='hidden' name='page' value='" + String(page) + "'>";
+  // repeated for the products on this page of the category, adding the product name, price, category and deposit checkbox for each product
+  File file = LittleFS.open(PRODUCTS_FILE, "r");
+  Product p;
+  int index = 0; // position of product within category
+  for (int id = 0; index < (page + 1) * PAGE_SIZE && readProduct(file, p); id++) {
+    if (p.category != cat) continue;
+    if (index++ < page * PAGE_SIZE) continue;
     html += "<div class='product-config'>";
     html += "<label>Name </label>";
-    html += "<input class='input-field' type='text' name='name_" + String(i) + "' value='" + String(products[i].name) + "'><br>";
+    html += "<input class='input-field' type='text' name='name_" + String(id) + "' value='" + p.name + "'><br>";
     html += "<label>Preis </label>";
-    html += "<input class='input-field' type='number' step='0.01' name='price_" + String(i) + "' value='" + String(products[i].price, 2) + "'><br>";
+    html += "<input class='input-field' type='number' step='0.01' name='price_" + String(id) + "' value='" + String(p.price, 2) + "'><br>";
+    html += "<label>Kategorie </label>";
+    html += generateCategorySelect("category_" + String(id), p.category) + "<br>";
     html += "<div style='display: flex; justify-content: space-between; align-items: center;'>";
-    html += "<label>Pfand <input type='checkbox' name='deposit_" + String(i) + "'" + (products[i].hasDeposit ? " checked" : "") + "></label>";
-    html += "<button type='button' style='background-color: red; color: white;' onclick='deleteProduct(" + String(i) + ")'>Produkt löschen</button>";
+    html += "<label>Pfand <input type='checkbox' name='deposit_" + String(id) + "'" + (p.hasDeposit ? " checked" : "") + "></label>";
+    html += "<button type='button' style='background-color: red; color: white;' onclick='deleteProduct(" + String(id) + ")'>Produkt löschen</button>";
     html += "</div>"; // End of flex line
     html += "</div>"; // end of product config block
   }
+  file.close();
+
+  // page links if category has more products than fit on one page
+  html += "<div class='tabs'>";
+  if (page > 0) html += "<a href='/?cat=" + String(cat) + "&page=" + String(page - 1) + "'>Zurück</a>";
+  if ((page + 1) * PAGE_SIZE < categoryProductCount[cat]) html += "<a href='/?cat=" + String(cat) + "&page=" + String(page + 1) + "'>Weiter</a>";
+  html += "</div>";
 
-  
   // Section for new Product at the end of the page
   html += "<h2>Neues Produkt</h2>";
   html += "<label>Name</label><input class='input-field' type='text' name='new_name'><br>";
   html += "<label>Preis</label><input class='input-field' type='number' step='0.01' name='new_price'><br>";
+  html += "<label>Kategorie</label>" + generateCategorySelect("new_category_id", cat) + "<br>";
   html += "<label>Pfand<input type='checkbox' name='new_deposit'></label><br>";
+
+  // Section for renaming or deleting the shown category, the first category can't be deleted since it takes the products of deleted ones
+  html += "<h2>Kategorie</h2>";
+  html += "<label>Name</label><input class='input-field' type='text' name='category_name' value='" + categories[cat] + "'><br>";
+  if (cat > 0) html += "<button type='button' style='background-color: red; color: white;' onclick='deleteCategory(" + String(cat) + ")'>Kategorie löschen</button>";
+
+  // Section for new category
+  html += "<h2>Neue Kategorie</h2>";
+  html += "<label>Name</label><input class='input-field' type='text' name='new_category'><br>";
   html += "<input type='submit' value='Speichern'></form>";
 
-  html += "<script>function deleteProduct(id){fetch('/deleteProduct?id='+id).then(()=>location.reload());}</script>"; // delete product script for button (references the function in the HTML))
+  html += "<script>function deleteProduct(id){fetch('/deleteProduct?id='+id).then(r=>r.ok?location.reload():r.text().then(alert));}</script>"; // delete product script for button (references the function in the HTML))
+  html += "<script>function deleteCategory(id){if(!confirm('Kategorie löschen? Ihre Produkte werden in die erste Kategorie verschoben.'))return;fetch('/deleteCategory',{method:'POST',body:new URLSearchParams({id:id})}).then(r=>r.ok?location.href='/':r.text().then(alert));}</script>";
 
   // footer with copyright 
   html += "<footer style='text-align: center; margin-top: 20px; font-size: 12px; color: #888;'>";
@@ -382,7 +657,6 @@ String generateConfigPage() {
 // Port 80 product page
 void handleRoot() {
   // HTML template for the product page
-  loadSalesFromEEPROM(); // load sales from EEPROM
   String html = R"rawliteral(
   <!DOCTYPE html>
   <html>
@@ -449,16 +723,46 @@ void handleRoot() {
         border: none;
         margin-top: 20px;
       }
+      .tab {
+        margin: 2px;
+        background-color: #007BFF;
+      }
+      .tab-active {
+        background-color: #0056b3;
+        font-weight: bold;
+      }
     </style>
     <script>
+      let category = 0; // shown category, only its products are loaded
+      let page = 0; // shown page within category
+
       function updateContent(){
-        fetch('/content').then(response => response.text()).then(html => {
+        fetch(`/content?cat=${category}&page=${page}`).then(response => response.text()).then(html => {
           document.getElementById('content').innerHTML = html;
         });
       }
 
+      function showCategory(c){
+        category = c;
+        page = 0;
+        updateContent();
+      }
+
+      function showPage(p){
+        page = p;
+        updateContent();
+      }
+
       function sendAction(action, id, quantity = 1){
-        fetch(`/${action}?id=${id}&quantity=${quantity}`).then(() => updateContent());
+        fetch(`/${action}?id=${id}&quantity=${quantity}`).then(response => response.text().then(text => {
+          if (!response.ok) alert(text); // e.g. cart full
+          // show order number and receipt link after submitting the order, register stays on this page for the next customer
+          if (action === 'submit' && parseInt(text) > 0) {
+            const receipt = `http://${location.host}/receipt?no=${text}`;
+            document.getElementById('order').innerHTML = `<h3>Bestellnummer ${text}<br><small>Beleg für Kunden: <a href='${receipt}' target='_blank'>${receipt}</a></small></h3>`;
+          }
+          updateContent();
+        }));
       }
 
       window.onload = function() {
@@ -468,6 +772,7 @@ void handleRoot() {
   </head>
   <body>
     <h1>Kassensystem</h1>
+    <div id="order"></div>
     <div id="content">
       Lade Produkte...
     </div>
@@ -482,55 +787,249 @@ void handleRoot() {
 void handleAdd() {
   int id = server.arg("id").toInt();
   int q = server.arg("quantity").toInt();
-  if (id >= 0 && id < productCount) products[id].count += q;
+  int i = findCartItem(id);
+  if (q > 0 && i >= 0) {
+    cart[i].count += q;
+  } else if (q > 0) {
+    if (cartSize >= CART_MAX_ITEMS) {
+      server.send(409, "text/plain", "Warenkorb voll: max. " + String(CART_MAX_ITEMS) + " verschiedene Produkte pro Bestellung");
+      return;
+    }
+    // product not in cart yet, copy its data from the file system
+    Product p;
+    if (readProductById(id, p)) {
+      cart[cartSize] = {(uint16_t)id, q, p.name, p.price, p.hasDeposit};
+      cartSize++;
+    }
+  }
   server.send(200, "text/plain", "OK");
 }
 
 // remove product from cart
 void handleRemove() {
   int id = server.arg("id").toInt();
-  if (id >= 0 && id < productCount && products[id].count > 0) products[id].count--;
+  int i = findCartItem(id);
+  if (i >= 0 && --cart[i].count <= 0) removeCartItem(i);
   server.send(200, "text/plain", "OK");
 }
 
 // clear all products in cart
 void handleClear() {
-  for (int i = 0; i < productCount; i++) products[i].count = 0;
+  cartSize = 0;
   server.send(200, "text/plain", "OK");
 }
 
 // submit order to server and save to EEPROM
+// also puts the order into the kitchen queue and sends back the order number
 void handleSubmit() {
-  for (int i = 0; i < productCount; i++) {
-    totalSold[i] += products[i].count;
-    products[i].count = 0;
+  if (cartSize > 0 && findFreeOrderSlot() < 0) {
+    server.send(409, "text/plain", "Küche voll: " + String(ORDER_QUEUE_SIZE) + " offene Bestellungen, bitte erst Bestellungen fertig melden");
+    return; // cart stays so the order can be submitted again
   }
+  uint8_t orderNumber = enqueueOrder(); // before clearing the cart so the order keeps its contents
+  for (int i = 0; i < cartSize; i++) {
+    setSold(cart[i].productId, getSold(cart[i].productId) + cart[i].count);
+  }
+  cartSize = 0;
   saveSalesToEEPROM();
-  server.send(200, "text/plain", "OK");
+  server.send(200, "text/plain", String(orderNumber));
+}
 
-  // Verkäufe aktualisieren (already handled above)
+// receipt page for the customer with order number and ordered products, opened on the customer's own phone
+// reloads itself until the kitchen marked the order as done
+void handleReceipt() {
+  Order* order = findOrder(server.arg("no").toInt());
+  String html = "<!DOCTYPE html><html><head><meta charset='UTF-8'><meta name='viewport' content='width=device-width, initial-scale=1.0'><title>Bestellung</title>";
+  if (order && !order->done) html += "<meta http-equiv='refresh' content='5'>"; // poll order status
+  html += "<style>body { font-family: Arial, sans-serif; padding: 20px; max-width: 600px; margin: auto; text-align: center; } .number { font-size: 96px; font-weight: bold; } ul { text-align: left; display: inline-block; }</style>";
+  html += "</head><body>";
+  if (order) {
+    html += "<h1>Deine Bestellnummer</h1>";
+    html += "<div class='number'>" + String(order->number) + "</div>";
+    html += generateOrderItems(*order);
+    html += order->done ? "<h3>Fertig, bitte abholen!</h3>" : "<h3>Wird zubereitet...</h3>";
+  } else {
+    html += "<h1>Bestellung nicht gefunden</h1>";
+  }
+  html += "</body></html>";
 
-  saveSalesToEEPROM(); // Deine Funktion zum Speichern der Verkäufe
+  server.send(200, "text/html", html);
+}
+
+// Kitchen display page, shows the queue and reloads it periodically so several displays can watch it
+String generateKitchenPage() {
+  String html = R"rawliteral(
+  <!DOCTYPE html>
+  <html>
+  <head>
+    <meta charset="UTF-8">
+    <meta name="viewport" content="width=device-width, initial-scale=1.0">
+    <title>Küche</title>
+    <style>
+      body {
+        font-family: Arial, sans-serif;
+        padding: 20px;
+        margin: auto;
+      }
+      h1 {
+        text-align: center;
+      }
+      .order {
+        display: inline-block;
+        vertical-align: top;
+        width: 250px;
+        border: 1px solid #ccc;
+        border-radius: 15px;
+        padding: 15px;
+        margin: 5px;
+        background-color: #f9f9f9;
+      }
+      .order h2 {
+        margin: 0;
+        font-size: 48px;
+      }
+      button {
+        width: 100%;
+        padding: 10px;
+        font-size: 18px;
+        border-radius: 10px;
+        border: none;
+        background-color: green;
+        color: white;
+        cursor: pointer;
+      }
+    </style>
+    <script>
+      let version = 0; // version of the shown queue, server answers 204 if it didn't change
+
+      function updateQueue(){
+        fetch(`/kitchenContent?v=${version}`).then(response => {
+          if (response.status !== 200) return;
+          version = response.headers.get('X-Queue-Version');
+          response.text().then(html => {
+            document.getElementById('queue').innerHTML = html;
+          });
+        });
+      }
+
+      function markDone(number){
+        fetch('/done', {method: 'POST', body: new URLSearchParams({no: number})}).then(() => updateQueue());
+      }
+
+      window.onload = function() {
+        updateQueue();
+        setInterval(updateQueue, 2000); // live update of the queue
+      }
+    </script>
+  </head>
+  <body>
+    <h1>Bestellungen</h1>
+    <div id="queue">
+      Lade Bestellungen...
+    </div>
+  </body>
+  </html>
+  )rawliteral";
+
+  return html;
+}
+
+// open orders of the queue, oldest first, with done buttons only for the kitchen on the config port
+String generateKitchenContent(bool withDoneButtons) {
+  // sort slots by sequence, queue is small enough for insertion sort
+  int slots[ORDER_QUEUE_SIZE];
+  for (int i = 0; i < ORDER_QUEUE_SIZE; i++) {
+    int k = i;
+    for (; k > 0 && orderQueue[slots[k - 1]].sequence > orderQueue[i].sequence; k--) slots[k] = slots[k - 1];
+    slots[k] = i;
+  }
+
+  String content = "";
+  for (int i = 0; i < ORDER_QUEUE_SIZE; i++) {
+    const Order &order = orderQueue[slots[i]];
+    if (order.number == 0 || order.done) continue;
+    content += "<div class='order'>";
+    content += "<h2>" + String(order.number) + "</h2>";
+    content += generateOrderItems(order);
+    if (withDoneButtons) content += "<button onclick='markDone(" + String(order.number) + ")'>Fertig</button>";
+    content += "</div>";
+  }
+  if (content.length() == 0) content = "<p style='text-align: center;'>Keine offenen Bestellungen</p>";
+  return content;
+}
+
+// Port 80 kitchen display, read only so customers in the WIFI can't change orders
+void handleKitchen() {
+  server.send(200, "text/html", generateKitchenPage());
+}
+
+// send queue only if it changed since the version the display already shows, so polling displays cost almost nothing
+void sendKitchenContent(WebServer &webServer, bool withDoneButtons) {
+  if (webServer.arg("v") == String(orderQueueVersion)) {
+    webServer.send(204);
+    return;
+  }
+  webServer.sendHeader("X-Queue-Version", String(orderQueueVersion));
+  webServer.send(200, "text/html", generateKitchenContent(withDoneButtons));
+}
+
+void handleKitchenContent() {
+  sendKitchenContent(server, false);
 }
 
 
 // update content of product page when action was performed by client (add, remove, clear)
+// only the products on the shown page of the shown category are read from the file system
 void handleContent() {
-  String content = "";
-  for (int i = 0; i < productCount; i++) {
+  int cat = server.arg("cat").toInt();
+  if (cat < 0 || cat >= categoryCount) cat = 0;
+  int page = server.arg("page").toInt();
+  if (page < 0) page = 0;
+
+  // category tabs
+  String content = "<div>";
+  for (int i = 0; i < categoryCount; i++) {
+    content += "<button onclick='showCategory(" + String(i) + ")' class='" + (i == cat ? "tab tab-active" : "tab") + "'>" + categories[i] + "</button>";
+  }
+  content += "</div>";
+
+  File file = LittleFS.open(PRODUCTS_FILE, "r");
+  Product p;
+  int index = 0; // position of product within category
+  for (int id = 0; index < (page + 1) * PAGE_SIZE && readProduct(file, p); id++) {
+    if (p.category != cat) continue;
+    if (index++ < page * PAGE_SIZE) continue;
     content += "<div class='product'>";
-    content += "<p><strong>" + String(products[i].name) + "</strong> (" + String(products[i].price, 2) + " €";
-    if (products[i].hasDeposit) content += " + 1 € Pfand";
+    content += "<p><strong>" + p.name + "</strong> (" + String(p.price, 2) + " €";
+    if (p.hasDeposit) content += " + 1 € Pfand";
     content += ")</p>";
     content += "<div class='row'><div class='left'>";
-    content += "<span>Anzahl: " + String(products[i].count) + "</span>";
-    content += "<button onclick='sendAction(\"add\", " + String(i) + ", 1)' class='button-green'>+1</button>";
-    content += "<button onclick='sendAction(\"add\", " + String(i) + ", 2)' class='button-green'>+2</button>";
-    content += "<button onclick='sendAction(\"add\", " + String(i) + ", 3)' class='button-green'>+3</button>";
+    content += "<span>Anzahl: " + String(cartCount(id)) + "</span>";
+    content += "<button onclick='sendAction(\"add\", " + String(id) + ", 1)' class='button-green'>+1</button>";
+    content += "<button onclick='sendAction(\"add\", " + String(id) + ", 2)' class='button-green'>+2</button>";
+    content += "<button onclick='sendAction(\"add\", " + String(id) + ", 3)' class='button-green'>+3</button>";
     content += "</div>";
-    content += "<button onclick='sendAction(\"remove\", " + String(i) + ")' class='button-red'>-1</button>";
+    content += "<button onclick='sendAction(\"remove\", " + String(id) + ")' class='button-red'>-1</button>";
     content += "</div></div>";
   }
+  file.close();
+  if (!fileSystemMounted) content += "<h3>Produkte konnten nicht geladen werden (Dateisystem-Fehler)</h3>";
+
+  // page buttons if category has more products than fit on one page
+  content += "<div class='row'>";
+  content += page > 0 ? "<button onclick='showPage(" + String(page - 1) + ")' class='tab'>Zurück</button>" : "<span></span>";
+  if ((page + 1) * PAGE_SIZE < categoryProductCount[cat]) content += "<button onclick='showPage(" + String(page + 1) + ")' class='tab'>Weiter</button>";
+  content += "</div>";
+
+  // cart overview, cart may contain products of other categories
+  if (cartSize > 0) {
+    content += "<div class='product'><p><strong>Warenkorb</strong></p>";
+    for (int i = 0; i < cartSize; i++) {
+      content += "<div class='row'><span>" + String(cart[i].count) + "x " + cart[i].name + "</span>";
+      content += "<button onclick='sendAction(\"remove\", " + String(cart[i].productId) + ")' class='button-red'>-1</button></div>";
+    }
+    content += "</div>";
+  }
 
   content += "<h3>Gesamtpreis: " + String(calculateTotal(), 2) + " €<br>";
   content += "<small>(inkl. " + String(calculateDeposit(), 2) + " € Pfand)</small></h3>";
@@ -555,53 +1054,145 @@ void handleContent() {
 
 // Port 8080 configuration page
 void handleConfig() {
-  configServer.send(200, "text/html", generateConfigPage()); // send HTML to client
+  int cat = configServer.arg("cat").toInt();
+  if (cat < 0 || cat >= categoryCount) cat = 0;
+  int page = configServer.arg("page").toInt();
+  if (page < 0) page = 0;
+  configServer.send(200, "text/html", generateConfigPage(cat, page)); // send HTML to client
+}
+
+// Port 8080 kitchen page, same as the display on port 80 but orders can be marked as done
+void handleConfigKitchen() {
+  configServer.send(200, "text/html", generateKitchenPage());
+}
+
+void handleConfigKitchenContent() {
+  sendKitchenContent(configServer, true);
+}
+
+// mark order as done from the kitchen
+void handleDone() {
+  Order* order = findOrder(configServer.arg("no").toInt());
+  if (order && !order->done) {
+    order->done = true;
+    orderQueueVersion++;
+  }
+  configServer.send(200, "text/plain", "OK");
 }
 
 // save configuration page
-// save new product to EEPROM and update product list
+// save edited products of the shown page, new product and new category to the file system
 void handleSaveConfig() {
-  for (int i = 0; i < productCount; i++) {
-    if (configServer.hasArg("name_" + String(i))) {
-      String name = configServer.arg("name_" + String(i));
-      name.toCharArray(products[i].name, sizeof(products[i].name));
-      products[i].price = configServer.arg("price_" + String(i)).toFloat();
-      products[i].hasDeposit = configServer.hasArg("deposit_" + String(i));
+  bool saved = rewriteProducts([](int id, Product &p) {
+    if (configServer.hasArg("name_" + String(id))) {
+      p.name = cleanName(configServer.arg("name_" + String(id)));
+      p.price = configServer.arg("price_" + String(id)).toFloat();
+      p.hasDeposit = configServer.hasArg("deposit_" + String(id));
+      int cat = configServer.arg("category_" + String(id)).toInt();
+      if (cat >= 0 && cat < categoryCount) p.category = cat;
     }
+    return true;
+  });
+
+  // keep product data in cart up to date
+  for (int i = 0; saved && i < cartSize; i++) {
+    String id = String(cart[i].productId);
+    if (!configServer.hasArg("name_" + id)) continue;
+    cart[i].name = cleanName(configServer.arg("name_" + id));
+    cart[i].price = configServer.arg("price_" + id).toFloat();
+    cart[i].hasDeposit = configServer.hasArg("deposit_" + id);
   }
-  if (configServer.hasArg("new_name") && configServer.arg("new_name").length() > 0 && productCount < MAX_PRODUCTS) {
-    String name = configServer.arg("new_name");
-    name.toCharArray(products[productCount].name, sizeof(products[productCount].name));
-    products[productCount].price = configServer.arg("new_price").toFloat();
-    products[productCount].hasDeposit = configServer.hasArg("new_deposit");
-    products[productCount].count = 0;
-    productCount++;
+
+  // rename shown category
+  int shownCat = configServer.arg("cat").toInt();
+  String categoryName = cleanName(configServer.arg("category_name"));
+  if (saved && categoryName.length() > 0 && shownCat >= 0 && shownCat < categoryCount && categoryName != categories[shownCat]) {
+    categories[shownCat] = categoryName;
+    saved = saveCategories();
+  }
+
+  if (saved && configServer.hasArg("new_category") && configServer.arg("new_category").length() > 0 && categoryCount < MAX_CATEGORIES) {
+    categories[categoryCount++] = cleanName(configServer.arg("new_category"));
+    saved = saveCategories();
   }
-  saveProductsToEEPROM();
-  configServer.sendHeader("Location", "/");
+
+  if (saved && configServer.hasArg("new_name") && configServer.arg("new_name").length() > 0 && productCount < MAX_PRODUCTS) {
+    int cat = configServer.arg("new_category_id").toInt();
+    Product p = {cleanName(configServer.arg("new_name")), configServer.arg("new_price").toFloat(), configServer.hasArg("new_deposit"), (uint8_t)(cat >= 0 && cat < categoryCount ? cat : 0)};
+    File file = LittleFS.open(PRODUCTS_FILE, "a");
+    saved = file && writeProduct(file, p);
+    file.close();
+    if (saved) {
+      setSold(productCount, 0); // new product id may hold sales of a deleted product
+      saveSalesToEEPROM();
+    }
+  }
+
+  loadCatalogue(); // update product count and category table
+  if (!saved) {
+    configServer.send(500, "text/plain", "Speichern fehlgeschlagen (Dateisystem voll?)");
+    return;
+  }
+  configServer.sendHeader("Location", "/?cat=" + configServer.arg("cat") + "&page=" + configServer.arg("page"));
   configServer.send(303);
 }
 
-// delete product from EEPROM and update product list
+// delete category, its products move to the first category and the following categories move up one id
+void handleDeleteCategory() {
+  int id = configServer.arg("id").toInt();
+  if (id <= 0 || id >= categoryCount) {
+    configServer.send(400, "text/plain", "Diese Kategorie kann nicht gelöscht werden");
+    return;
+  }
+
+  bool saved = rewriteProducts([id](int i, Product &p) {
+    if (p.category == id) p.category = 0;
+    else if (p.category > id) p.category--;
+    return true;
+  });
+  if (saved) {
+    for (int i = id; i < categoryCount - 1; i++) {
+      categories[i] = categories[i + 1];
+    }
+    categoryCount--;
+    saved = saveCategories();
+  }
+
+  loadCatalogue(); // update category table and product counts
+  if (!saved) {
+    configServer.send(500, "text/plain", "Löschen fehlgeschlagen");
+    return;
+  }
+  configServer.send(200, "text/plain", "OK");
+}
+
+// delete product from file system and update product ids
 void handleDeleteProduct() {
   int id = configServer.arg("id").toInt();
 
   // Ensure the ID is within valid range
   if (id >= 0 && id < productCount) {
-    // Shift the products in the array
-    for (int i = id; i < productCount - 1; i++) {
-      products[i] = products[i + 1];
+    // Remove the line of the product, following products move up one id
+    if (!rewriteProducts([id](int i, Product &p) { return i != id; })) {
+      configServer.send(500, "text/plain", "Löschen fehlgeschlagen");
+      return;
     }
 
-    // Clear the last product (optional, for cleanup)
-    Product emptyProduct = {};
-    EEPROM.put((productCount - 1) * sizeof(Product) + sizeof(int), emptyProduct);
-
-    // Decrease the product count
-    productCount--;
+    // Shift sales counters to the new ids
+    for (int i = id; i < productCount - 1; i++) {
+      setSold(i, getSold(i + 1));
+    }
+    setSold(productCount - 1, 0);
+    saveSalesToEEPROM();
+
+    // Shift ids in cart, order queue keeps its own copy of the names
+    int index = findCartItem(id);
+    if (index >= 0) removeCartItem(index);
+    for (int i = 0; i < cartSize; i++) {
+      if (cart[i].productId > id) cart[i].productId--;
+    }
 
-    // Save the updated products and product count to EEPROM
-    saveProductsToEEPROM();
+    loadCatalogue(); // update product count, loads default products if last product was deleted
   }
 
   // Send success response to the client
@@ -618,21 +1209,14 @@ void setup() {
   // Serial and Wifi Module
   Serial.begin(115200);
   EEPROM.begin(EEPROM_SIZE);
+  fileSystemMounted = LittleFS.begin(true); // format file system on first start
+  if (!fileSystemMounted) {
+    Serial.println("LittleFS could not be mounted, no products available.");
+  }
   WiFi.softAP(ssid, password);
   Serial.println("AP IP: " + WiFi.softAPIP().toString());
 
-  loadProductsFromEEPROM();
-  if (productCount == 0) {
-    Serial.println("No products found in EEPROM, loading default products. productCount: " + String(productCount));
-    for (int i = 0; i < defaultProductCount && i < MAX_PRODUCTS; i++) {
-      products[i] = defaultProducts[i];
-    }
-    productCount = defaultProductCount;
-    saveProductsToEEPROM();
-    saveSalesToEEPROM();  // Verkäufe auch initialisieren
-  }
-
-  loadSalesFromEEPROM(); // Beispiel-Funktion, die du schreiben musst
+  loadCatalogue(); // loads default products if file system is empty
 
 
   // Port 80
@@ -642,6 +1226,9 @@ void setup() {
   server.on("/clear", handleClear);
   server.on("/content", handleContent);
   server.on("/submit", handleSubmit);
+  server.on("/receipt", handleReceipt);
+  server.on("/kitchen", handleKitchen);
+  server.on("/kitchenContent", handleKitchenContent);
   server.on("/sales", handleSalesOverview);
   server.on("/resetSales", HTTP_POST, handleResetSales);
   server.on("/exportSales", HTTP_POST, handleExportSales);
@@ -657,6 +1244,10 @@ void setup() {
   configServer.on("/", handleConfig);
   configServer.on("/saveConfig", HTTP_POST, handleSaveConfig);
   configServer.on("/deleteProduct", handleDeleteProduct);
+  configServer.on("/deleteCategory", HTTP_POST, handleDeleteCategory);
+  configServer.on("/kitchen", handleConfigKitchen);
+  configServer.on("/kitchenContent", handleConfigKitchenContent);
+  configServer.on("/done", HTTP_POST, handleDone);
 
   server.begin();       // launch product page server so client can request page
   configServer.begin(); // launch config page server so client can request page
@@ -664,6 +1255,8 @@ void setup() {
 
   Serial.println("product page running on port 80");
   Serial.println("config page running on port 8080");
+  Serial.println("kitchen display running on port 80 at /kitchen (read only)");
+  Serial.println("kitchen page running on port 8080 at /kitchen");
 }
 
 